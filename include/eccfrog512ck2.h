@@ -20,16 +20,27 @@ public:
 
     ECCFrog512CK2();
 
+    mpz_class get_p() const { return p; }
+    mpz_class get_a() const { return a; }
+    mpz_class get_b() const { return b; }
     mpz_class get_n() const { return n; }
+    mpz_class get_h() const { return h; }
     Point get_G() const { return G; }
 
     Point infinity() const;
     Point add_points(const Point& P, const Point& Q) const;
     Point scalar_mul(const Point& P, const mpz_class& k) const;
     Point point_from_compressed_hex(const std::string& hex) const;
+    // Decompresses and validates a whole keyring; throws on the first bad entry
+    std::vector<Point> points_from_compressed_hex(const std::vector<std::string>& hexes) const;
     Point point_from_uncompressed(const std::vector<unsigned char>& bytes) const;
     Point point_from_pgp(const std::string& pgp_data) const;
 
+    bool is_on_curve(const Point& P) const;
+    bool is_valid_public_point(const Point& P) const;
+    // Square root modulo p; returns false if v is not a quadratic residue
+    bool sqrt_mod_p(const mpz_class& v, mpz_class& root) const;
+
 private:
     mpz_class p, a, b, n, h;
     Point G;
@@ -0,0 +1,60 @@
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <gmpxx.h>
+#include <array>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "eccfrog512ck2.h"
+
+// Archive layout (format 2). The payload is sealed under a random data key and
+// only the fixed-size header depends on the recipient, so a rekey rewrites the
+// header in place and never touches the ciphertext.
+//
+//   "FRG2" | eph_pub_size (u16, always 129) | eph_pub (129) | wrap_iv (12) |
+//   wrapped_key (32) | wrap_tag (16) | iv (12) | tag (16) | ciphertext
+//
+// The wrapping key is HKDF-SHA256 over the 64-byte big-endian ECDH x-coordinate,
+// with the ephemeral and recipient public keys as context.
+struct EnvelopeHeader {
+    std::vector<unsigned char> eph_pub;
+    std::array<unsigned char, 12> wrap_iv{};
+    std::array<unsigned char, 32> wrapped_key{};
+    std::array<unsigned char, 16> wrap_tag{};
+    std::array<unsigned char, 12> iv{};
+    std::array<unsigned char, 16> tag{};
+
+    size_t size() const;
+};
+
+mpz_class load_private_key(const std::string& privkey_path);
+ECCFrog512CK2::Point load_public_key(const std::string& pubkey_path, const ECCFrog512CK2& curve);
+
+// Legacy archives: AES-256 key taken from the hex x-coordinate of the shared point
+std::vector<unsigned char> derive_shared_key(const ECCFrog512CK2::Point& shared_point);
+
+// Format 2: AES-256 key-wrapping key for the given ECDH exchange
+std::vector<unsigned char> derive_wrap_key(const ECCFrog512CK2::Point& shared_point,
+                                           const std::vector<unsigned char>& eph_pub,
+                                           const std::vector<unsigned char>& recipient_pub);
+
+// Returns false and rewinds if the stream does not start with a format 2 header
+bool read_envelope_header(std::istream& in, EnvelopeHeader& header);
+std::vector<unsigned char> encode_envelope_header(const EnvelopeHeader& header);
+void write_envelope_header(std::ostream& out, const EnvelopeHeader& header);
+
+// Seals data_key for recipient under a fresh ephemeral key; iv and tag must
+// already be set. Returns the wrapping key so a writer can verify the result.
+std::vector<unsigned char> wrap_data_key(EnvelopeHeader& header,
+                                         const std::vector<unsigned char>& data_key,
+                                         const ECCFrog512CK2::Point& recipient,
+                                         const ECCFrog512CK2& curve);
+std::vector<unsigned char> unwrap_data_key(const EnvelopeHeader& header,
+                                           const mpz_class& priv_key,
+                                           const ECCFrog512CK2& curve);
+std::vector<unsigned char> unwrap_data_key(const EnvelopeHeader& header,
+                                           const std::vector<unsigned char>& kek);
+
+#endif
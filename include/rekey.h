@@ -0,0 +1,16 @@
+#ifndef REKEY_H
+#define REKEY_H
+
+#include <string>
+
+// Re-wraps the data key of a format 2 archive for a new recipient, rewriting
+// only the header in place. A directory is processed recursively in parallel.
+//
+// This does not revoke access: the data key is unchanged, so the old private
+// key, an old copy of the header or the data key itself still decrypt the
+// archive. Re-encrypt with decrypt_file/encrypt_file when revocation is needed.
+void rekey_path(const std::string& path,
+                const std::string& old_privkey_path,
+                const std::string& new_pubkey_path);
+
+#endif
@@ -0,0 +1,220 @@
+#include "eccfrog512ck2.h"
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Point decompression for ECCFrog512CK2.
+//
+// p = 1 (mod 8) and p - 1 = 2^3 * t with t odd, so square roots are taken with
+// Tonelli-Shanks. The expensive part is one mpz_powm by the constant
+// (t-1)/2; the 2-adic correction uses a precomputed primitive 8th root of
+// unity and costs at most a handful of products.
+
+namespace {
+
+const char* const FROG_P =
+    "9149012705592502490164965176888130701548053918699793689672344807772801105830681498780746622530729418858477103073591918058480028776841126664954537807339721";
+
+// (t - 1) / 2 where p - 1 = 2^3 * t
+const char* const SQRT_EXP_HEX =
+    "aeaf714c13bfbff63dd6c4f07dd366674ebe93f6ec6ea51ac8584d9982c41882"
+    "ebea6f6e7b0e959d2c36ba5e27705daffacd9a49b39d5beedc74976b30a260c";
+
+// 3^t mod p (3 is the smallest quadratic non-residue)
+const char* const ROOT8_HEX =
+    "58110c3ddd98ccddd00177c926dd7c771307dff42a4b744314dc64e5f0fb65f1"
+    "843dc855f3f81b319d9060ebeac587c5e02e361b4c3cc1edb00a415e0cfc4686";
+
+const unsigned TWO_ADICITY = 3;
+const size_t POINTS_PER_THREAD = 256;
+
+// Constants that depend only on p, parsed once and shared by every thread
+struct SqrtConsts {
+    mpz_class p, exp, root8;
+
+    SqrtConsts() : p(FROG_P, 10), exp(SQRT_EXP_HEX, 16), root8(ROOT8_HEX, 16) {}
+};
+
+const SqrtConsts& sqrt_consts() {
+    static const SqrtConsts consts;
+    return consts;
+}
+
+// Per-thread temporaries, reused across points to avoid reallocating limbs
+struct SqrtScratch {
+    mpz_class w, x, b, z, g, t, rhs;
+};
+
+inline void mul_mod(mpz_class& r, const mpz_class& u, const mpz_class& v, const mpz_class& p) {
+    mpz_mul(r.get_mpz_t(), u.get_mpz_t(), v.get_mpz_t());
+    mpz_tdiv_r(r.get_mpz_t(), r.get_mpz_t(), p.get_mpz_t());
+}
+
+// v must already be reduced into [0, p)
+bool tonelli_shanks(const SqrtConsts& c, SqrtScratch& s, const mpz_class& v, mpz_class& root) {
+    const mpz_class& p = c.p;
+    if (v == 0) {
+        root = 0;
+        return true;
+    }
+
+    // w = v^((t-1)/2), x = v^((t+1)/2), b = v^t, z = primitive 2^3-th root of unity
+    mpz_powm(s.w.get_mpz_t(), v.get_mpz_t(), c.exp.get_mpz_t(), p.get_mpz_t());
+    mul_mod(s.x, v, s.w, p);
+    mul_mod(s.b, s.x, s.w, p);
+    s.z = c.root8;
+    unsigned m = TWO_ADICITY;
+
+    while (s.b != 1) {
+        unsigned i = 0;
+        s.t = s.b;
+        while (s.t != 1) {
+            mul_mod(s.t, s.t, s.t, p);
+            if (++i == m) return false;
+        }
+        s.g = s.z;
+        for (unsigned k = 0; k + i + 1 < m; ++k) {
+            mul_mod(s.g, s.g, s.g, p);
+        }
+        mul_mod(s.x, s.x, s.g, p);
+        mul_mod(s.z, s.g, s.g, p);
+        mul_mod(s.b, s.b, s.z, p);
+        m = i;
+    }
+
+    root = s.x;
+    return true;
+}
+
+struct CurveConsts {
+    mpz_class p, a, b;
+
+    explicit CurveConsts(const ECCFrog512CK2& curve)
+        : p(curve.get_p()), a(curve.get_a()), b(curve.get_b()) {
+        if (p != sqrt_consts().p) {
+            throw std::runtime_error("Square root constants do not match the curve prime");
+        }
+        a %= p;
+        if (a < 0) a += p;
+    }
+};
+
+ECCFrog512CK2::Point decode_compressed(const ECCFrog512CK2& curve,
+                                       const CurveConsts& k,
+                                       SqrtScratch& s,
+                                       const std::string& hex) {
+    // 02/03 prefix followed by at most 128 hex digits of x (leading zeros optional)
+    if (hex.size() < 3 || hex.size() > 130 || hex[0] != '0' || (hex[1] != '2' && hex[1] != '3')) {
+        throw std::runtime_error("Invalid compressed point encoding");
+    }
+    for (size_t i = 2; i < hex.size(); ++i) {
+        if (!isxdigit(static_cast<unsigned char>(hex[i]))) {
+            throw std::runtime_error("Invalid hex digit in compressed point");
+        }
+    }
+
+    mpz_class x(hex.substr(2), 16);
+    if (x >= k.p) throw std::runtime_error("Compressed point x-coordinate out of range");
+
+    // rhs = x^3 + a*x + b
+    mul_mod(s.rhs, x, x, k.p);
+    s.rhs += k.a;
+    mul_mod(s.rhs, s.rhs, x, k.p);
+    s.rhs += k.b;
+    mpz_tdiv_r(s.rhs.get_mpz_t(), s.rhs.get_mpz_t(), k.p.get_mpz_t());
+
+    mpz_class y;
+    if (!tonelli_shanks(sqrt_consts(), s, s.rhs, y)) {
+        throw std::runtime_error("Compressed point is not on the curve");
+    }
+    bool want_odd = (hex[1] == '3');
+    if (mpz_odd_p(y.get_mpz_t()) != static_cast<int>(want_odd)) {
+        if (y == 0) throw std::runtime_error("Compressed point has invalid parity");
+        y = k.p - y;
+    }
+
+    ECCFrog512CK2::Point P(x, y);
+    if (!curve.is_valid_public_point(P)) {
+        throw std::runtime_error("Decompressed point failed validation");
+    }
+    return P;
+}
+
+} // namespace
+
+bool ECCFrog512CK2::sqrt_mod_p(const mpz_class& v, mpz_class& root) const {
+    CurveConsts k(*this);
+    SqrtScratch s;
+    mpz_class r = v % k.p;
+    if (r < 0) r += k.p;
+    return tonelli_shanks(sqrt_consts(), s, r, root);
+}
+
+bool ECCFrog512CK2::is_on_curve(const Point& P) const {
+    if (P.at_infinity) return true;
+    mpz_class lhs = (P.y * P.y - P.x * P.x * P.x - a * P.x - b) % p;
+    return lhs == 0;
+}
+
+bool ECCFrog512CK2::is_valid_public_point(const Point& P) const {
+    if (P.at_infinity) return false;
+    if (P.x < 0 || P.x >= p || P.y < 0 || P.y >= p) return false;
+    if (!is_on_curve(P)) return false;
+    // With cofactor 1 every curve point is in the prime-order subgroup
+    if (h == 1) return true;
+    return scalar_mul(P, n).at_infinity;
+}
+
+ECCFrog512CK2::Point ECCFrog512CK2::point_from_compressed_hex(const std::string& hex) const {
+    CurveConsts k(*this);
+    SqrtScratch s;
+    return decode_compressed(*this, k, s, hex);
+}
+
+std::vector<ECCFrog512CK2::Point>
+ECCFrog512CK2::points_from_compressed_hex(const std::vector<std::string>& hexes) const {
+    std::vector<Point> points(hexes.size());
+    if (hexes.empty()) return points;
+
+    const CurveConsts k(*this);
+    sqrt_consts();  // parse the shared constants before the workers start
+
+    size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    size_t workers = std::min(hw, (hexes.size() + POINTS_PER_THREAD - 1) / POINTS_PER_THREAD);
+    size_t chunk = (hexes.size() + workers - 1) / workers;
+
+    std::vector<std::pair<size_t, std::exception_ptr>> errors(workers, {hexes.size(), nullptr});
+    auto run = [&](size_t w) {
+        SqrtScratch s;
+        size_t end = std::min(hexes.size(), (w + 1) * chunk);
+        for (size_t i = w * chunk; i < end; ++i) {
+            try {
+                points[i] = decode_compressed(*this, k, s, hexes[i]);
+            } catch (...) {
+                errors[w] = {i, std::current_exception()};
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; ++w) threads.emplace_back(run, w);
+    run(0);
+    for (auto& t : threads) t.join();
+
+    for (const auto& [index, err] : errors) {
+        if (!err) continue;
+        try {
+            std::rethrow_exception(err);
+        } catch (const std::exception& e) {
+            throw std::runtime_error("Invalid compressed key at index " +
+                                     std::to_string(index) + ": " + e.what());
+        }
+    }
+    return points;
+}
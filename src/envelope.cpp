@@ -0,0 +1,269 @@
+#include "envelope.h"
+#include "keygen.h"
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+static const unsigned char ENVELOPE_MAGIC[4] = {'F', 'R', 'G', '2'};
+static const size_t EPH_PUB_SIZE = 129;
+static const char WRAP_KEY_INFO[] = "ECCFrog512CK2 FRG2 key wrap";
+
+static std::string extract_pgp_payload(const std::string& data) {
+    std::string hex;
+    std::istringstream iss(data);
+    std::string line;
+    bool inside = false;
+
+    while (std::getline(iss, line)) {
+        if (line.find("-----BEGIN") != std::string::npos) {
+            inside = true;
+            continue;
+        }
+        if (line.find("-----END") != std::string::npos) {
+            break;
+        }
+        if (inside) {
+            for (char c : line) {
+                if (isxdigit(c)) {
+                    hex += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+                }
+            }
+        }
+    }
+
+    if (hex.empty()) {
+        throw std::runtime_error("No PGP payload found");
+    }
+    return hex;
+}
+
+static std::string read_pgp_file(const std::string& path, const char* what) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error(std::string("Failed to open ") + what + " file");
+
+    std::string pgp_data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+    return extract_pgp_payload(pgp_data);
+}
+
+// The wrapped key is bound to the ephemeral key and to the payload IV/tag it unlocks
+static std::vector<unsigned char> wrap_aad(const EnvelopeHeader& header) {
+    std::vector<unsigned char> aad(sizeof(ENVELOPE_MAGIC) + header.eph_pub.size() +
+                                   header.iv.size() + header.tag.size());
+    auto out = std::copy(std::begin(ENVELOPE_MAGIC), std::end(ENVELOPE_MAGIC), aad.begin());
+    out = std::copy(header.eph_pub.begin(), header.eph_pub.end(), out);
+    out = std::copy(header.iv.begin(), header.iv.end(), out);
+    std::copy(header.tag.begin(), header.tag.end(), out);
+    return aad;
+}
+
+size_t EnvelopeHeader::size() const {
+    return sizeof(ENVELOPE_MAGIC) + sizeof(uint16_t) + eph_pub.size() +
+           wrap_iv.size() + wrapped_key.size() + wrap_tag.size() + iv.size() + tag.size();
+}
+
+mpz_class load_private_key(const std::string& privkey_path) {
+    return mpz_class(read_pgp_file(privkey_path, "private key"), 16);
+}
+
+ECCFrog512CK2::Point load_public_key(const std::string& pubkey_path, const ECCFrog512CK2& curve) {
+    std::ifstream file(pubkey_path);
+    if (!file) throw std::runtime_error("Failed to open public key file");
+
+    std::string pgp_data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+    ECCFrog512CK2::Point pub_point = curve.point_from_pgp(pgp_data);
+
+    if (!curve.is_valid_public_point(pub_point)) {
+        throw std::runtime_error("Public key is not a valid ECCFrog512CK2 point");
+    }
+    return pub_point;
+}
+
+std::vector<unsigned char> derive_shared_key(const ECCFrog512CK2::Point& shared_point) {
+    std::string shared_secret = shared_point.x.get_str(16);
+    // Ensure exactly 64 characters by padding with leading zeros or truncating
+    shared_secret = std::string(64 - std::min<size_t>(64, shared_secret.length()), '0') + shared_secret;
+    shared_secret = shared_secret.substr(0, 64);
+
+    std::vector<unsigned char> aes_key(32);
+    for (size_t i = 0; i < 32; ++i) {
+        aes_key[i] = static_cast<unsigned char>(
+            std::stoul(shared_secret.substr(i * 2, 2), nullptr, 16));
+    }
+    return aes_key;
+}
+
+std::vector<unsigned char> derive_wrap_key(const ECCFrog512CK2::Point& shared_point,
+                                           const std::vector<unsigned char>& eph_pub,
+                                           const std::vector<unsigned char>& recipient_pub) {
+    // Fixed-width x so every bit of the shared secret feeds the KDF
+    std::vector<unsigned char> ikm = shared_point.to_uncompressed_bytes();
+    ikm = std::vector<unsigned char>(ikm.begin() + 1, ikm.begin() + 65);
+
+    std::vector<unsigned char> info(WRAP_KEY_INFO, WRAP_KEY_INFO + sizeof(WRAP_KEY_INFO) - 1);
+    info.insert(info.end(), eph_pub.begin(), eph_pub.end());
+    info.insert(info.end(), recipient_pub.begin(), recipient_pub.end());
+
+    std::vector<unsigned char> kek(32);
+    size_t kek_len = kek.size();
+    EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, nullptr);
+    if (!pctx) throw std::runtime_error("Failed to create HKDF context");
+
+    if (EVP_PKEY_derive_init(pctx) <= 0 ||
+        EVP_PKEY_CTX_set_hkdf_md(pctx, EVP_sha256()) <= 0 ||
+        EVP_PKEY_CTX_set1_hkdf_key(pctx, ikm.data(), ikm.size()) <= 0 ||
+        EVP_PKEY_CTX_add1_hkdf_info(pctx, info.data(), info.size()) <= 0 ||
+        EVP_PKEY_derive(pctx, kek.data(), &kek_len) <= 0 ||
+        kek_len != kek.size()) {
+        EVP_PKEY_CTX_free(pctx);
+        throw std::runtime_error("Failed to derive key wrapping key");
+    }
+    EVP_PKEY_CTX_free(pctx);
+    return kek;
+}
+
+bool read_envelope_header(std::istream& in, EnvelopeHeader& header) {
+    unsigned char magic[sizeof(ENVELOPE_MAGIC)];
+    in.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    if (static_cast<size_t>(in.gcount()) != sizeof(magic) ||
+        std::memcmp(magic, ENVELOPE_MAGIC, sizeof(magic)) != 0) {
+        in.clear();
+        in.seekg(0);
+        return false;
+    }
+
+    uint16_t eph_pub_size = 0;
+    in.read(reinterpret_cast<char*>(&eph_pub_size), sizeof(eph_pub_size));
+    if (static_cast<size_t>(in.gcount()) != sizeof(eph_pub_size)) {
+        throw std::runtime_error("Failed to read ephemeral public key size");
+    }
+    if (eph_pub_size != EPH_PUB_SIZE) {
+        throw std::runtime_error("Unexpected ephemeral public key size in envelope header");
+    }
+    header.eph_pub.resize(eph_pub_size);
+
+    auto read_field = [&](unsigned char* data, size_t size, const char* what) {
+        in.read(reinterpret_cast<char*>(data), size);
+        if (static_cast<size_t>(in.gcount()) != size) {
+            throw std::runtime_error(std::string("Failed to read ") + what);
+        }
+    };
+    read_field(header.eph_pub.data(), header.eph_pub.size(), "ephemeral public key bytes");
+    read_field(header.wrap_iv.data(), header.wrap_iv.size(), "key wrap IV");
+    read_field(header.wrapped_key.data(), header.wrapped_key.size(), "wrapped data key");
+    read_field(header.wrap_tag.data(), header.wrap_tag.size(), "key wrap tag");
+    read_field(header.iv.data(), header.iv.size(), "IV");
+    read_field(header.tag.data(), header.tag.size(), "authentication tag");
+    return true;
+}
+
+std::vector<unsigned char> encode_envelope_header(const EnvelopeHeader& header) {
+    if (header.eph_pub.size() != EPH_PUB_SIZE) {
+        throw std::runtime_error("Unexpected ephemeral public key size in envelope header");
+    }
+
+    std::vector<unsigned char> buf(header.size());
+    uint16_t eph_pub_size = static_cast<uint16_t>(header.eph_pub.size());
+    const unsigned char* size_bytes = reinterpret_cast<const unsigned char*>(&eph_pub_size);
+    auto out = std::copy(std::begin(ENVELOPE_MAGIC), std::end(ENVELOPE_MAGIC), buf.begin());
+    out = std::copy(size_bytes, size_bytes + sizeof(eph_pub_size), out);
+    out = std::copy(header.eph_pub.begin(), header.eph_pub.end(), out);
+    out = std::copy(header.wrap_iv.begin(), header.wrap_iv.end(), out);
+    out = std::copy(header.wrapped_key.begin(), header.wrapped_key.end(), out);
+    out = std::copy(header.wrap_tag.begin(), header.wrap_tag.end(), out);
+    out = std::copy(header.iv.begin(), header.iv.end(), out);
+    std::copy(header.tag.begin(), header.tag.end(), out);
+    return buf;
+}
+
+void write_envelope_header(std::ostream& out, const EnvelopeHeader& header) {
+    std::vector<unsigned char> buf = encode_envelope_header(header);
+    out.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+    if (!out) throw std::runtime_error("Failed to write envelope header");
+}
+
+std::vector<unsigned char> wrap_data_key(EnvelopeHeader& header,
+                                         const std::vector<unsigned char>& data_key,
+                                         const ECCFrog512CK2::Point& recipient,
+                                         const ECCFrog512CK2& curve) {
+    if (data_key.size() != header.wrapped_key.size()) {
+        throw std::runtime_error("Data key has the wrong length");
+    }
+
+    mpz_class eph_priv = generate_secure_private_key(curve.get_n());
+    ECCFrog512CK2::Point eph_pub = curve.scalar_mul(curve.get_G(), eph_priv);
+    header.eph_pub = eph_pub.to_uncompressed_bytes();
+    std::vector<unsigned char> kek = derive_wrap_key(curve.scalar_mul(recipient, eph_priv),
+                                                     header.eph_pub,
+                                                     recipient.to_uncompressed_bytes());
+
+    if (RAND_bytes(header.wrap_iv.data(), header.wrap_iv.size()) != 1) {
+        throw std::runtime_error("Failed to generate key wrap IV");
+    }
+    std::vector<unsigned char> aad = wrap_aad(header);
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) throw std::runtime_error("Failed to create cipher context");
+
+    int len = 0;
+    if (EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, header.wrap_iv.size(), nullptr) != 1 ||
+        EVP_EncryptInit_ex(ctx, nullptr, nullptr, kek.data(), header.wrap_iv.data()) != 1 ||
+        EVP_EncryptUpdate(ctx, nullptr, &len, aad.data(), aad.size()) != 1 ||
+        EVP_EncryptUpdate(ctx, header.wrapped_key.data(), &len, data_key.data(), data_key.size()) != 1 ||
+        EVP_EncryptFinal_ex(ctx, header.wrapped_key.data() + len, &len) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, header.wrap_tag.size(), header.wrap_tag.data()) != 1) {
+        EVP_CIPHER_CTX_free(ctx);
+        throw std::runtime_error("Failed to wrap data key");
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return kek;
+}
+
+std::vector<unsigned char> unwrap_data_key(const EnvelopeHeader& header,
+                                           const mpz_class& priv_key,
+                                           const ECCFrog512CK2& curve) {
+    ECCFrog512CK2::Point eph_pub = curve.point_from_uncompressed(header.eph_pub);
+    if (!curve.is_valid_public_point(eph_pub)) {
+        throw std::runtime_error("Ephemeral public key is not a valid ECCFrog512CK2 point");
+    }
+    ECCFrog512CK2::Point recipient = curve.scalar_mul(curve.get_G(), priv_key);
+    std::vector<unsigned char> kek = derive_wrap_key(curve.scalar_mul(eph_pub, priv_key),
+                                                     header.eph_pub,
+                                                     recipient.to_uncompressed_bytes());
+    return unwrap_data_key(header, kek);
+}
+
+std::vector<unsigned char> unwrap_data_key(const EnvelopeHeader& header,
+                                           const std::vector<unsigned char>& kek) {
+    std::vector<unsigned char> aad = wrap_aad(header);
+    std::vector<unsigned char> data_key(header.wrapped_key.size());
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) throw std::runtime_error("Failed to create cipher context");
+
+    int len = 0;
+    std::array<unsigned char, 16> tag = header.wrap_tag;
+    if (EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, header.wrap_iv.size(), nullptr) != 1 ||
+        EVP_DecryptInit_ex(ctx, nullptr, nullptr, kek.data(), header.wrap_iv.data()) != 1 ||
+        EVP_DecryptUpdate(ctx, nullptr, &len, aad.data(), aad.size()) != 1 ||
+        EVP_DecryptUpdate(ctx, data_key.data(), &len, header.wrapped_key.data(), header.wrapped_key.size()) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, tag.size(), tag.data()) != 1) {
+        EVP_CIPHER_CTX_free(ctx);
+        throw std::runtime_error("Failed to unwrap data key");
+    }
+
+    int ret = EVP_DecryptFinal_ex(ctx, data_key.data() + len, &len);
+    EVP_CIPHER_CTX_free(ctx);
+    if (ret <= 0) {
+        throw std::runtime_error("Failed to unwrap data key: wrong private key or corrupted header");
+    }
+    return data_key;
+}
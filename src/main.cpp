@@ -1,22 +1,84 @@
 #include <iostream>
-#include "eccfrog512ck2.hpp"
+#include <string>
+#include "decrypt.h"
+#include "eccfrog512ck2.h"
+#include "encrypt.h"
+#include "envelope.h"
+#include "keygen.h"
+#include "rekey.h"
 
-int main() {
-    ECCFrog512CK2 ecc;
+static void print_usage(const char* prog) {
+    std::cerr << "Usage:\n"
+              << "  " << prog << " --generate-keys\n"
+              << "  " << prog << " --encrypt INPUT [OUTPUT] [PUBKEY]\n"
+              << "  " << prog << " --decrypt INPUT [OUTPUT] [PRIVKEY]\n"
+              << "  " << prog << " --verify-keys [PRIVKEY] [PUBKEY]\n"
+              << "  " << prog << " --rekey OLD_PRIV NEW_PUB PATH...\n";
+}
+
+static std::string arg_or(int argc, char* argv[], int i, const char* fallback) {
+    return i < argc ? argv[i] : fallback;
+}
 
-    std::cout << "Checking if twist is secure...\n";
-    std::cout << (ecc.is_twist_secure() ? "Twist secure.\n" : "Twist NOT secure.\n");
+static void verify_keys(const std::string& privkey_path, const std::string& pubkey_path) {
+    ECCFrog512CK2 curve;
+    mpz_class priv_key = load_private_key(privkey_path);
+    ECCFrog512CK2::Point pub_key = load_public_key(pubkey_path, curve);
+    ECCFrog512CK2::Point derived = curve.scalar_mul(curve.get_G(), priv_key);
 
-    auto [priv, pub] = ecc.generate_keypair();
+    if (derived.x != pub_key.x || derived.y != pub_key.y) {
+        throw std::runtime_error("Public key does not match private key");
+    }
+    std::cout << "[+] Key pair is valid\n";
+}
 
-    std::cout << "\nPrivate Key:\n" << priv.get_str() << "\n";
-    std::cout << "\nPublic Key (compressed):\n" << ecc.compress(pub) << "\n";
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const std::string mode = argv[1];
 
-    std::cout << "\nBenchmarking scalar multiplication methods...\n";
-    ecc.benchmark();
+    if (mode == "--rekey") {
+        if (argc < 5) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        // Keep going past a bad path so one failure does not skip the rest
+        int failed = 0;
+        for (int i = 4; i < argc; ++i) {
+            try {
+                rekey_path(argv[i], argv[2], argv[3]);
+            } catch (const std::exception&) {
+                ++failed;
+            }
+        }
+        if (failed) {
+            std::cerr << "[-] " << failed << " of " << argc - 4 << " paths failed\n";
+            return 1;
+        }
+        return 0;
+    }
 
+    try {
+        if (mode == "--generate-keys") {
+            generate_keys();
+        } else if (mode == "--encrypt" && argc >= 3) {
+            encrypt_file(argv[2], arg_or(argc, argv, 3, "encrypted.enc"),
+                         arg_or(argc, argv, 4, "public_key.pem"));
+        } else if (mode == "--decrypt" && argc >= 3) {
+            decrypt_file(argv[2], arg_or(argc, argv, 3, "decrypted.out"),
+                         arg_or(argc, argv, 4, "private_key.pem"));
+        } else if (mode == "--verify-keys") {
+            verify_keys(arg_or(argc, argv, 2, "private_key.pem"),
+                        arg_or(argc, argv, 3, "public_key.pem"));
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        if (mode == "--verify-keys") std::cerr << "[-] " << e.what() << "\n";
+        return 1;
+    }
     return 0;
 }
-std::cout << "\nTesting GLV scalar multiplication...\n";
-auto glv = ecc.scalar_mult_GLV(123456789, ecc.Gx, ecc.Gy);
-std::cout << "GLV X: " << glv.first.get_str().substr(0, 64) << "..." << std::endl;
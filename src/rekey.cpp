@@ -0,0 +1,216 @@
+#include "rekey.h"
+#include "eccfrog512ck2.h"
+#include "envelope.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Crash safety: the old header is first journaled to "<archive>.rekey". The
+// journal is written to a temporary name, fsynced and renamed, so it either
+// exists complete or not at all. Only then is the archive header overwritten
+// and fsynced; the new header is re-read and unwrapped before the journal is
+// removed. A run that finds a journal left behind restores the journaled
+// header, unless the archive's current header already unwraps with the key
+// it was given.
+static const char JOURNAL_SUFFIX[] = ".rekey";
+static const char JOURNAL_TMP_SUFFIX[] = ".rekey.tmp";
+
+namespace {
+
+struct FileDescriptor {
+    int fd;
+
+    FileDescriptor(const std::string& path, int flags, mode_t mode = 0)
+        : fd(::open(path.c_str(), flags | O_CLOEXEC, mode)) {
+        if (fd < 0) throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+    }
+    ~FileDescriptor() { ::close(fd); }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    void write_at(const std::vector<unsigned char>& buf, off_t offset) {
+        size_t done = 0;
+        while (done < buf.size()) {
+            ssize_t n = ::pwrite(fd, buf.data() + done, buf.size() - done, offset + done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) throw std::runtime_error(std::string("Write failed: ") + std::strerror(errno));
+            done += static_cast<size_t>(n);
+        }
+    }
+
+    void sync() {
+        if (::fsync(fd) != 0) throw std::runtime_error(std::string("fsync failed: ") + std::strerror(errno));
+    }
+};
+
+} // namespace
+
+static void sync_parent_dir(const std::string& path) {
+    fs::path parent = fs::absolute(path).parent_path();
+    FileDescriptor dir(parent.string(), O_RDONLY | O_DIRECTORY);
+    dir.sync();
+}
+
+static bool load_header(const std::string& path, EnvelopeHeader& header) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Failed to open " + path);
+    return read_envelope_header(in, header);
+}
+
+static void write_header_durably(const std::string& path, const EnvelopeHeader& header) {
+    FileDescriptor file(path, O_WRONLY);
+    file.write_at(encode_envelope_header(header), 0);
+    file.sync();
+}
+
+static void write_journal(const std::string& journal, const EnvelopeHeader& header) {
+    std::string tmp = journal.substr(0, journal.size() - (sizeof(JOURNAL_SUFFIX) - 1)) + JOURNAL_TMP_SUFFIX;
+    {
+        FileDescriptor file(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        file.write_at(encode_envelope_header(header), 0);
+        file.sync();
+    }
+    if (::rename(tmp.c_str(), journal.c_str()) != 0) {
+        throw std::runtime_error("Failed to commit rekey journal: " + std::string(std::strerror(errno)));
+    }
+    sync_parent_dir(journal);
+}
+
+static void remove_journal(const std::string& journal) {
+    fs::remove(journal);
+    sync_parent_dir(journal);
+}
+
+// Brings an archive back to a consistent header after an interrupted rekey
+static void recover_from_journal(const std::string& path,
+                                 const std::string& journal,
+                                 const mpz_class& old_priv,
+                                 const ECCFrog512CK2& curve) {
+    try {
+        EnvelopeHeader current;
+        if (load_header(path, current)) {
+            unwrap_data_key(current, old_priv, curve);
+            remove_journal(journal);
+            return;
+        }
+    } catch (const std::exception&) {
+        // Torn or foreign header; fall through to the journaled copy
+    }
+
+    EnvelopeHeader saved;
+    if (!load_header(journal, saved)) {
+        throw std::runtime_error("Rekey journal is corrupt: " + journal);
+    }
+    write_header_durably(path, saved);
+    remove_journal(journal);
+}
+
+static void rekey_file(const std::string& path,
+                       const mpz_class& old_priv,
+                       const ECCFrog512CK2::Point& new_pub,
+                       const ECCFrog512CK2& curve) {
+    const std::string journal = path + JOURNAL_SUFFIX;
+    fs::remove(path + JOURNAL_TMP_SUFFIX);
+    if (fs::exists(journal)) recover_from_journal(path, journal, old_priv, curve);
+
+    EnvelopeHeader header;
+    if (!load_header(path, header)) {
+        throw std::runtime_error("Legacy archive format; decrypt and re-encrypt it once to enable rekeying");
+    }
+    const EnvelopeHeader old_header = header;
+
+    std::vector<unsigned char> data_key = unwrap_data_key(header, old_priv, curve);
+    std::vector<unsigned char> kek = wrap_data_key(header, data_key, new_pub, curve);
+    if (header.size() != old_header.size()) {
+        throw std::runtime_error("New header size differs from the original");
+    }
+
+    // Payload IV, tag and ciphertext are unchanged; only the header is rewritten
+    write_journal(journal, old_header);
+    write_header_durably(path, header);
+
+    EnvelopeHeader written;
+    if (!load_header(path, written) ||
+        encode_envelope_header(written) != encode_envelope_header(header) ||
+        unwrap_data_key(written, kek) != data_key) {
+        throw std::runtime_error("Rewritten header failed verification; rerun --rekey to restore it");
+    }
+    remove_journal(journal);
+}
+
+static bool is_journal_file(const std::string& name) {
+    auto ends_with = [&](const char* suffix) {
+        std::string s(suffix);
+        return name.size() >= s.size() && name.compare(name.size() - s.size(), s.size(), s) == 0;
+    };
+    return ends_with(JOURNAL_SUFFIX) || ends_with(JOURNAL_TMP_SUFFIX);
+}
+
+void rekey_path(const std::string& path,
+                const std::string& old_privkey_path,
+                const std::string& new_pubkey_path) {
+    try {
+        ECCFrog512CK2 curve;
+        mpz_class old_priv = load_private_key(old_privkey_path);
+        ECCFrog512CK2::Point new_pub = load_public_key(new_pubkey_path, curve);
+
+        if (!fs::is_directory(path)) {
+            rekey_file(path, old_priv, new_pub, curve);
+            std::cout << "[+] Archive rekeyed: " << path << "\n";
+            return;
+        }
+
+        std::vector<std::string> files;
+        for (const auto& entry : fs::recursive_directory_iterator(path)) {
+            if (entry.is_regular_file() && !is_journal_file(entry.path().string())) {
+                files.push_back(entry.path().string());
+            }
+        }
+
+        // Each archive costs two scalar multiplications and a header write, so
+        // the work is CPU-bound and spreads evenly across hardware threads
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> failed{0};
+        std::mutex log_mutex;
+        auto worker = [&]() {
+            for (size_t i = next++; i < files.size(); i = next++) {
+                try {
+                    rekey_file(files[i], old_priv, new_pub, curve);
+                } catch (const std::exception& e) {
+                    ++failed;
+                    std::lock_guard<std::mutex> lock(log_mutex);
+                    std::cerr << "[-] " << files[i] << ": " << e.what() << "\n";
+                }
+            }
+        };
+
+        size_t workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                          std::max<size_t>(1, files.size()));
+        std::vector<std::thread> threads;
+        for (size_t w = 1; w < workers; ++w) threads.emplace_back(worker);
+        worker();
+        for (auto& t : threads) t.join();
+
+        std::cout << "[+] Rekeyed " << files.size() - failed << " of " << files.size()
+                  << " archives in: " << path << "\n";
+        if (failed) {
+            throw std::runtime_error(std::to_string(failed.load()) + " archives could not be rekeyed");
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "[-] Rekey error: " << e.what() << "\n";
+        throw;
+    }
+}
@@ -0,0 +1,258 @@
+// OpenFrogget unit tests
+// Build and run with: make test
+
+#include "decrypt.h"
+#include "eccfrog512ck2.h"
+#include "encrypt.h"
+#include "envelope.h"
+#include "keygen.h"
+#include "rekey.h"
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            std::cerr << "[-] " << __FILE__ << ":" << __LINE__ << ": " #cond \
+                      << "\n";                                               \
+            ++failures;                                                      \
+        }                                                                    \
+    } while (0)
+
+template <typename F>
+static bool throws(F&& f, const std::string& needle = "") {
+    try {
+        f();
+    } catch (const std::exception& e) {
+        return std::string(e.what()).find(needle) != std::string::npos;
+    }
+    return false;
+}
+
+static mpz_class curve_rhs(const ECCFrog512CK2& curve, const mpz_class& x) {
+    mpz_class p = curve.get_p();
+    mpz_class r = (x * x * x + curve.get_a() * x + curve.get_b()) % p;
+    return r < 0 ? r + p : r;
+}
+
+static void test_sqrt_mod_p() {
+    ECCFrog512CK2 curve;
+    mpz_class p = curve.get_p();
+    for (unsigned long v = 1; v < 200; ++v) {
+        mpz_class root;
+        bool ok = curve.sqrt_mod_p(v, root);
+        CHECK(ok == (mpz_legendre(mpz_class(v).get_mpz_t(), p.get_mpz_t()) == 1));
+        if (ok) CHECK((root * root - v) % p == 0);
+    }
+}
+
+static void test_decompress_generator() {
+    ECCFrog512CK2 curve;
+    ECCFrog512CK2::Point G = curve.get_G();
+    ECCFrog512CK2::Point P = curve.point_from_compressed_hex(G.to_compressed_hex());
+    CHECK(P.x == G.x && P.y == G.y);
+
+    // Opposite parity prefix yields -G
+    std::string hex = G.to_compressed_hex();
+    hex[1] = (hex[1] == '2') ? '3' : '2';
+    ECCFrog512CK2::Point N = curve.point_from_compressed_hex(hex);
+    CHECK(N.x == G.x && N.y == curve.get_p() - G.y);
+}
+
+static void test_decompress_rejects_invalid() {
+    ECCFrog512CK2 curve;
+    mpz_class p = curve.get_p();
+
+    mpz_class x = 1;
+    while (mpz_legendre(curve_rhs(curve, x).get_mpz_t(), p.get_mpz_t()) != -1) ++x;
+    CHECK(throws([&] { curve.point_from_compressed_hex("02" + x.get_str(16)); }, "not on the curve"));
+
+    CHECK(throws([&] { curve.point_from_compressed_hex("02" + p.get_str(16)); }, "out of range"));
+    CHECK(throws([&] { curve.point_from_compressed_hex("04" + x.get_str(16)); }));
+    CHECK(throws([&] { curve.point_from_compressed_hex("02xyz"); }));
+}
+
+static void test_batch_decompress() {
+    ECCFrog512CK2 curve;
+    std::vector<ECCFrog512CK2::Point> expected;
+    std::vector<std::string> hexes;
+    ECCFrog512CK2::Point P = curve.get_G();
+    for (int i = 0; i < 64; ++i) {
+        expected.push_back(P);
+        hexes.push_back(P.to_compressed_hex());
+        P = curve.add_points(P, curve.get_G());
+    }
+
+    std::vector<ECCFrog512CK2::Point> points = curve.points_from_compressed_hex(hexes);
+    CHECK(points.size() == expected.size());
+    for (size_t i = 0; i < points.size() && i < expected.size(); ++i) {
+        CHECK(points[i].x == expected[i].x && points[i].y == expected[i].y);
+    }
+
+    hexes[37] = "02" + curve.get_p().get_str(16);
+    CHECK(throws([&] { curve.points_from_compressed_hex(hexes); }, "index 37"));
+}
+
+// 4 magic + 2 size + 129 eph_pub + 12 wrap_iv + 32 wrapped_key + 16 wrap_tag + 12 iv + 16 tag
+static const size_t FRG2_HEADER_SIZE = 223;
+
+static std::string slurp(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+static void spit(const fs::path& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(data.data(), data.size());
+}
+
+static std::string to_hex(const std::vector<unsigned char>& bytes) {
+    std::ostringstream oss;
+    for (unsigned char byte : bytes) {
+        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
+    }
+    return oss.str();
+}
+
+static std::string pem(const std::string& type, const std::string& hex) {
+    std::ostringstream oss;
+    oss << "-----BEGIN ECCFROG512 " << type << "-----\n" << hex << "\n"
+        << "-----END ECCFROG512 " << type << "-----\n";
+    return oss.str();
+}
+
+struct TestKeys {
+    std::string priv_path, pub_path;
+    ECCFrog512CK2::Point pub;
+};
+
+static TestKeys make_keys(const ECCFrog512CK2& curve, const fs::path& dir, const std::string& name) {
+    mpz_class priv = generate_secure_private_key(curve.get_n());
+    TestKeys keys{(dir / (name + "_priv.pem")).string(), (dir / (name + "_pub.pem")).string(),
+                  curve.scalar_mul(curve.get_G(), priv)};
+    spit(keys.priv_path, pem("PRIVATE KEY", priv.get_str(16)));
+    spit(keys.pub_path, pem("PUBLIC KEY", to_hex(keys.pub.to_uncompressed_bytes())));
+    return keys;
+}
+
+// Writes an archive in the pre-FRG2 layout, where the AES key is the ECDH secret
+static void write_legacy_archive(const ECCFrog512CK2& curve, const ECCFrog512CK2::Point& recipient,
+                                 const std::string& plaintext, const fs::path& path) {
+    mpz_class eph_priv = generate_secure_private_key(curve.get_n());
+    std::vector<unsigned char> eph_pub = curve.scalar_mul(curve.get_G(), eph_priv).to_uncompressed_bytes();
+    std::vector<unsigned char> key = derive_shared_key(curve.scalar_mul(recipient, eph_priv));
+
+    std::vector<unsigned char> iv(12), tag(16), ct(plaintext.size());
+    RAND_bytes(iv.data(), iv.size());
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    int len = 0;
+    EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, key.data(), iv.data());
+    EVP_EncryptUpdate(ctx, ct.data(), &len, reinterpret_cast<const unsigned char*>(plaintext.data()),
+                      plaintext.size());
+    EVP_EncryptFinal_ex(ctx, ct.data() + len, &len);
+    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, tag.size(), tag.data());
+    EVP_CIPHER_CTX_free(ctx);
+
+    std::ofstream out(path, std::ios::binary);
+    uint16_t eph_pub_size = static_cast<uint16_t>(eph_pub.size());
+    out.write(reinterpret_cast<const char*>(&eph_pub_size), sizeof(eph_pub_size));
+    out.write(reinterpret_cast<const char*>(eph_pub.data()), eph_pub.size());
+    out.write(reinterpret_cast<const char*>(iv.data()), iv.size());
+    out.write(reinterpret_cast<const char*>(tag.data()), tag.size());
+    out.write(reinterpret_cast<const char*>(ct.data()), ct.size());
+}
+
+static void test_archives(const fs::path& dir) {
+    ECCFrog512CK2 curve;
+    TestKeys a = make_keys(curve, dir, "a");
+    TestKeys b = make_keys(curve, dir, "b");
+    fs::path plain = dir / "plain.txt";
+    spit(plain, "The frog sits on the log.\n");
+
+    // FRG2 round trip
+    fs::path enc = dir / "plain.enc";
+    encrypt_file(plain.string(), enc.string(), a.pub_path);
+    CHECK(slurp(enc).compare(0, 4, "FRG2") == 0);
+    decrypt_file(enc.string(), (dir / "out1").string(), a.priv_path);
+    CHECK(slurp(dir / "out1") == slurp(plain));
+
+    // Rekey rewrites only the header
+    std::string before = slurp(enc);
+    rekey_path(enc.string(), a.priv_path, b.pub_path);
+    std::string after = slurp(enc);
+    CHECK(before.size() == after.size());
+    CHECK(before.substr(FRG2_HEADER_SIZE) == after.substr(FRG2_HEADER_SIZE));
+    CHECK(before.substr(0, FRG2_HEADER_SIZE) != after.substr(0, FRG2_HEADER_SIZE));
+    CHECK(!fs::exists(enc.string() + ".rekey"));
+    decrypt_file(enc.string(), (dir / "out2").string(), b.priv_path);
+    CHECK(slurp(dir / "out2") == slurp(plain));
+    CHECK(throws([&] { decrypt_file(enc.string(), (dir / "out3").string(), a.priv_path); }));
+
+    // Interrupted rekey: journal holds the good header, archive header is torn
+    std::string torn = after;
+    std::fill(torn.begin() + 150, torn.begin() + 180, '\0');
+    spit(enc.string() + ".rekey", after.substr(0, FRG2_HEADER_SIZE));
+    spit(enc, torn);
+    rekey_path(enc.string(), b.priv_path, a.pub_path);
+    CHECK(!fs::exists(enc.string() + ".rekey"));
+    CHECK(slurp(enc).substr(FRG2_HEADER_SIZE) == before.substr(FRG2_HEADER_SIZE));
+    decrypt_file(enc.string(), (dir / "out4").string(), a.priv_path);
+    CHECK(slurp(dir / "out4") == slurp(plain));
+
+    // Legacy archives still decrypt, but cannot be rekeyed header-only
+    fs::path legacy = dir / "legacy.enc";
+    write_legacy_archive(curve, a.pub, slurp(plain), legacy);
+    decrypt_file(legacy.string(), (dir / "out5").string(), a.priv_path);
+    CHECK(slurp(dir / "out5") == slurp(plain));
+    CHECK(throws([&] { rekey_path(legacy.string(), a.priv_path, b.pub_path); }, "Legacy"));
+
+    // Directory rekey keeps going past a bad archive and reports it
+    fs::path tree = dir / "tree";
+    fs::create_directories(tree / "sub");
+    for (int i = 0; i < 4; ++i) {
+        fs::path target = tree / (i % 2 ? "sub" : "") / "f";
+        target += std::to_string(i) + ".enc";
+        encrypt_file(plain.string(), target.string(), a.pub_path);
+    }
+    fs::copy_file(legacy, tree / "legacy.enc");
+    CHECK(throws([&] { rekey_path(tree.string(), a.priv_path, b.pub_path); }, "1 archives"));
+    decrypt_file((tree / "sub" / "f3.enc").string(), (dir / "out6").string(), b.priv_path);
+    CHECK(slurp(dir / "out6") == slurp(plain));
+}
+
+int main() {
+    test_sqrt_mod_p();
+    test_decompress_generator();
+    test_decompress_rejects_invalid();
+    test_batch_decompress();
+
+    fs::path dir = fs::temp_directory_path() / ("openfrogget_tests_" + std::to_string(getpid()));
+    fs::create_directories(dir);
+    try {
+        test_archives(dir);
+    } catch (const std::exception& e) {
+        std::cerr << "[-] Unexpected exception: " << e.what() << "\n";
+        ++failures;
+    }
+    fs::remove_all(dir);
+
+    if (failures) {
+        std::cerr << "[-] " << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "[+] All tests passed\n";
+    return 0;
+}